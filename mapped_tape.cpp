@@ -0,0 +1,129 @@
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped_tape.h"
+
+using namespace std;
+
+static void system_error(const string &what, const string &filename) {
+    throw std::runtime_error(what + " " + filename + ": " + strerror(errno));
+}
+
+static size_t system_page_size() {
+    return (size_t) sysconf(_SC_PAGESIZE);
+}
+
+MappedTape::MappedTape(const string &filename_, bool fresh)
+        : filename(filename_), fd(-1), cells(nullptr), length(0), capacity(0),
+          page_cells(system_cells_per_page()), last_dirty_page(SIZE_MAX) {
+    fd = open(filename.c_str(), O_RDWR | O_CREAT | (fresh ? O_TRUNC : 0), 0644);
+    if (fd < 0)
+        system_error("Cannot open", filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        system_error("Cannot stat", filename);
+    reserve(max((size_t) st.st_size / sizeof(int), (size_t) 1));
+}
+
+MappedTape::MappedTape(MappedTape &&other) noexcept
+        : filename(std::move(other.filename)), fd(other.fd), cells(other.cells), length(other.length),
+          capacity(other.capacity), page_cells(other.page_cells), is_dirty(std::move(other.is_dirty)),
+          dirty(std::move(other.dirty)), last_dirty_page(other.last_dirty_page) {
+    other.fd = -1;
+    other.cells = nullptr;
+}
+
+MappedTape::~MappedTape() {
+    if (cells)
+        munmap(cells, capacity * sizeof(int));
+    if (fd >= 0)
+        close(fd);
+}
+
+// grows the file (and the mapping) to at least new_capacity cells, rounded up to whole extents
+void MappedTape::reserve(size_t new_capacity) {
+    if (cells && new_capacity <= capacity)
+        return;
+    size_t extent = page_cells * TAPE_EXTENT_PAGES;
+    new_capacity = (new_capacity + extent - 1) / extent * extent;
+    if (ftruncate(fd, (off_t) (new_capacity * sizeof(int))) != 0)
+        system_error("Cannot extend", filename);
+    void *mapped;
+    if (cells)
+        mapped = mremap(cells, capacity * sizeof(int), new_capacity * sizeof(int), MREMAP_MAYMOVE);
+    else
+        mapped = mmap(nullptr, new_capacity * sizeof(int), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED)
+        system_error("Cannot map", filename);
+    cells = (int *) mapped;
+    capacity = new_capacity;
+    is_dirty.resize(capacity / page_cells, false);
+}
+
+// cells past the length are always blank, both in the file and in memory
+void MappedTape::push_back(int letter) {
+    if (length == capacity)
+        reserve(length + 1);
+    if (cells[length] != letter)
+        (*this)[length] = letter;
+    ++length;
+}
+
+void MappedTape::resize(size_t new_length) {
+    reserve(new_length);
+    length = new_length;
+}
+
+void MappedTape::write_back() {
+    size_t page_bytes = page_cells * sizeof(int);
+    for (size_t index: dirty) {
+        if (pwrite(fd, page(index), page_bytes, (off_t) (index * page_bytes)) != (ssize_t) page_bytes)
+            system_error("Cannot write", filename);
+    }
+    if (fsync(fd) != 0)
+        system_error("Cannot sync", filename);
+    // the private copies now match the file, so they can be dropped and read back from it when needed
+    for (size_t index: dirty) {
+        madvise(cells + index * page_cells, page_bytes, MADV_DONTNEED);
+        is_dirty[index] = false;
+    }
+    dirty.clear();
+    last_dirty_page = SIZE_MAX;
+}
+
+void MappedTape::write_pages(const string &filename, const map<size_t, vector<int>> &pages) {
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        system_error("Cannot open", filename);
+    size_t page_bytes = system_page_size();
+    for (const auto &page: pages) {
+        if (page.second.size() * sizeof(int) != page_bytes)
+            throw std::runtime_error("Page of a wrong size for " + filename);
+        if (pwrite(fd, page.second.data(), page_bytes, (off_t) (page.first * page_bytes)) != (ssize_t) page_bytes)
+            system_error("Cannot write", filename);
+    }
+    if (fsync(fd) != 0)
+        system_error("Cannot sync", filename);
+    close(fd);
+}
+
+size_t MappedTape::system_cells_per_page() {
+    return system_page_size() / sizeof(int);
+}
+
+void MappedTape::sync_file(const string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        system_error("Cannot open", filename);
+    if (fsync(fd) != 0)
+        system_error("Cannot sync", filename);
+    close(fd);
+}
@@ -0,0 +1,94 @@
+#ifndef __MAPPED_TAPE_H
+#define __MAPPED_TAPE_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// a tape (a sequence of letter ids) kept in a file and mapped into memory;
+// the file grows in extents of TAPE_EXTENT_PAGES pages
+#define TAPE_EXTENT_PAGES 256
+
+// The mapping is private: changes reach the file only through write_back(), so the file always holds
+// the tape as of the last write_back(). Pages changed since then are listed by dirty_pages().
+class MappedTape {
+public:
+    // with fresh, the file is created empty (or truncated); otherwise its contents are kept, but size() is 0
+    // until resize() is called
+    MappedTape(const std::string &filename, bool fresh);
+
+    MappedTape(MappedTape &&other) noexcept;
+
+    MappedTape(const MappedTape &) = delete;
+
+    MappedTape &operator=(const MappedTape &) = delete;
+
+    ~MappedTape();
+
+    int operator[](size_t pos) const {
+        return cells[pos];
+    }
+
+    // marks the page as dirty, even if the cell is only read; use the const version for reading
+    int &operator[](size_t pos) {
+        size_t page = pos / page_cells;
+        if (page != last_dirty_page) {
+            last_dirty_page = page;
+            if (!is_dirty[page]) {
+                is_dirty[page] = true;
+                dirty.push_back(page);
+            }
+        }
+        return cells[pos];
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    void push_back(int letter);
+
+    // the cells keep what the file holds
+    void resize(size_t new_length);
+
+    size_t cells_per_page() const {
+        return page_cells;
+    }
+
+    const std::vector<size_t> &dirty_pages() const {
+        return dirty;
+    }
+
+    const int *page(size_t index) const {
+        return cells + index * page_cells;
+    }
+
+    // writes the dirty pages to the file, waits until they are on disk, and releases their memory
+    void write_back();
+
+    // writes whole pages (by their index) straight to the file and waits until they are on disk;
+    // meant for a file not mapped at the moment
+    static void write_pages(const std::string &filename, const std::map<size_t, std::vector<int>> &pages);
+
+    static size_t system_cells_per_page();
+
+    // waits until the file (or directory) is on disk
+    static void sync_file(const std::string &filename);
+
+private:
+    std::string filename;
+    int fd;
+    int *cells;
+    size_t length;
+    size_t capacity; // in cells; equal to the size of the file
+    size_t page_cells;
+
+    std::vector<bool> is_dirty;
+    std::vector<size_t> dirty;
+    size_t last_dirty_page;
+
+    void reserve(size_t new_capacity);
+};
+
+#endif
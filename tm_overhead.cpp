@@ -0,0 +1,247 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <random>
+#include <string>
+#include "turing_machine_converter.cpp"
+#include "turing_machine_simulator.h"
+
+using namespace std;
+
+#define DEFAULT_MAX_LENGTH 64
+#define DEFAULT_SAMPLES 1
+// per run; a tape grows by at most one cell a step, so this also bounds the memory of a run
+#define DEFAULT_MAX_STEPS 1000000
+
+static void print_usage(const string &error) {
+    cerr << "ERROR: " << error << "\n"
+         << "Usage: tm_overhead [--family repeat|cycle|random] [--max-length <n>] [--samples <n>]"
+            " [--max-steps <n>] [--format csv|json] <input_file>\n"
+         << "where <input_file> is a valid two-tape machine\n";
+    exit(1);
+}
+
+static long long parse_number(const string &option, const string &value) {
+    try {
+        size_t last;
+        long long res = stoll(value, &last);
+        if (last != value.length() || res < 0)
+            throw 0;
+        return res;
+    } catch (...) {
+        print_usage(option + " should be followed by a nonnegative integer");
+    }
+    return 0;
+}
+
+// input words of the given length:
+// * repeat - the first letter of the input alphabet repeated
+// * cycle - the letters of the input alphabet in turn
+// * random - uniformly random letters (with a fixed seed, so that runs are reproducible)
+static vector<string> make_input(const TuringMachine &tm, const string &family, size_t length, mt19937 &gen) {
+    vector<string> input;
+    for (size_t a = 0; a < length; ++a) {
+        size_t letter = 0;
+        if (family == "cycle")
+            letter = a % tm.input_alphabet.size();
+        else if (family == "random")
+            letter = uniform_int_distribution<size_t>(0, tm.input_alphabet.size() - 1)(gen);
+        input.emplace_back(tm.input_alphabet[letter]);
+    }
+    return input;
+}
+
+struct Run {
+    size_t length;
+    string input;
+    RunStats two_tape, one_tape;
+};
+
+static bool halted(const RunStats &stats) {
+    return stats.result == RUN_ACCEPT || stats.result == RUN_REJECT;
+}
+
+// least squares fit of y = coefficient * x^exponent on a log-log scale; NAN if fewer than 2 distinct xs
+static pair<double, double> fit_power_law(const vector<pair<double, double>> &points) {
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const auto &point: points) {
+        if (point.first <= 0 || point.second <= 0)
+            continue;
+        double x = log(point.first), y = log(point.second);
+        n += 1;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double denominator = n * sxx - sx * sx;
+    if (n < 2 || denominator <= 1e-12)
+        return make_pair(NAN, NAN);
+    double exponent = (n * sxy - sx * sy) / denominator;
+    return make_pair(exponent, exp((sy - exponent * sx) / n));
+}
+
+static void output_number(ostream &output, double x, bool json) {
+    if (std::isnan(x))
+        output << (json ? "null" : "nan");
+    else
+        output << x;
+}
+
+
+static int overhead_main(int argc, char *argv[]) {
+    string two_tape_filename;
+    string family = "random";
+    string format = "csv";
+    long long max_length = DEFAULT_MAX_LENGTH;
+    long long samples = DEFAULT_SAMPLES;
+    long long max_steps = DEFAULT_MAX_STEPS;
+    int ok = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 2, "--") == 0) {
+            if (++i == argc)
+                print_usage("Missing value after " + arg);
+            string value = argv[i];
+            if (arg == "--family" && (value == "repeat" || value == "cycle" || value == "random"))
+                family = value;
+            else if (arg == "--format" && (value == "csv" || value == "json"))
+                format = value;
+            else if (arg == "--max-length")
+                max_length = parse_number(arg, value);
+            else if (arg == "--samples")
+                samples = parse_number(arg, value);
+            else if (arg == "--max-steps")
+                max_steps = parse_number(arg, value);
+            else
+                print_usage("Invalid option " + arg + " " + value);
+        } else if (ok == 0) {
+            two_tape_filename = arg;
+            ++ok;
+        } else
+            print_usage("Too many arguments");
+    }
+    if (ok == 0)
+        print_usage("Not enough arguments");
+    if (family != "random")
+        samples = 1;
+
+    FILE *f = fopen(two_tape_filename.c_str(), "r");
+    if (!f) {
+        cerr << "ERROR: File " << two_tape_filename << " does not exist\n";
+        return 1;
+    }
+    TuringMachine tm = read_tm_from_file(f);
+    if (tm.num_tapes != 2) {
+        cerr << "ERROR: The machine in " << two_tape_filename << " does not have two tapes\n";
+        return 1;
+    }
+    sections_t sections;
+    TuringMachine one_tape_tm = two_tape_to_one_tape(tm, &sections);
+
+    Simulator two_tape_simulator(tm);
+    Simulator one_tape_simulator(one_tape_tm);
+    vector<long long> hits = one_tape_simulator.empty_hit_counts();
+
+    // lengths 0, 1, 2, 4, ..., max_length
+    vector<Run> runs;
+    mt19937 gen(0);
+    for (long long length = 0; length <= max_length; length = length ? length * 2 : 1) {
+        for (long long sample = 0; sample < samples; ++sample) {
+            vector<string> input = make_input(tm, family, length, gen);
+            Run run;
+            run.length = length;
+            for (const auto &letter: input)
+                run.input += letter;
+            run.two_tape = two_tape_simulator.run(input, max_steps);
+            run.one_tape = one_tape_simulator.run(input, max_steps, &hits);
+            runs.push_back(run);
+        }
+    }
+
+    // runs that looped or ran out of steps say nothing about the number of steps, so they are left out of the fits
+    vector<pair<double, double>> steps_vs_steps, steps_vs_length;
+    for (const auto &run: runs) {
+        if (!halted(run.two_tape) || !halted(run.one_tape))
+            continue;
+        steps_vs_steps.emplace_back(run.two_tape.steps, run.one_tape.steps);
+        steps_vs_length.emplace_back(run.length, run.one_tape.steps);
+    }
+    auto fit_steps = fit_power_law(steps_vs_steps);
+    auto fit_length = fit_power_law(steps_vs_length);
+
+    profile_t profile;
+    one_tape_simulator.add_to_profile(hits, profile);
+    map<string, long long> section_steps;
+    long long total_steps = 0;
+    for (const auto &entry: profile) {
+        section_steps[sections.at(entry.first)] += entry.second;
+        total_steps += entry.second;
+    }
+
+    bool json = format == "json";
+    if (json) {
+        cout << "{\n  \"family\": \"" << family << "\",\n  \"runs\": [";
+        for (size_t a = 0; a < runs.size(); ++a) {
+            const Run &run = runs[a];
+            cout << (a ? "," : "") << "\n    {\"length\": " << run.length << ", \"input\": \"" << run.input << "\""
+                 << ", \"two_tape_result\": \"" << run_result_name(run.two_tape.result) << "\""
+                 << ", \"two_tape_steps\": " << run.two_tape.steps
+                 << ", \"two_tape_extent\": " << run.two_tape.tape_extent
+                 << ", \"one_tape_result\": \"" << run_result_name(run.one_tape.result) << "\""
+                 << ", \"one_tape_steps\": " << run.one_tape.steps
+                 << ", \"one_tape_extent\": " << run.one_tape.tape_extent << "}";
+        }
+        cout << "\n  ],\n  \"sections\": {";
+        bool first = true;
+        for (const auto &section: section_steps) {
+            cout << (first ? "" : ",") << "\n    \"" << section.first << "\": " << section.second;
+            first = false;
+        }
+        cout << "\n  },\n  \"fit_vs_two_tape_steps\": {\"exponent\": ";
+        output_number(cout, fit_steps.first, json);
+        cout << ", \"coefficient\": ";
+        output_number(cout, fit_steps.second, json);
+        cout << "},\n  \"fit_vs_length\": {\"exponent\": ";
+        output_number(cout, fit_length.first, json);
+        cout << ", \"coefficient\": ";
+        output_number(cout, fit_length.second, json);
+        cout << "}\n}\n";
+    } else {
+        cout << "length,input,two_tape_result,two_tape_steps,two_tape_extent,"
+                "one_tape_result,one_tape_steps,one_tape_extent\n";
+        for (const auto &run: runs)
+            cout << run.length << "," << run.input << ","
+                 << run_result_name(run.two_tape.result) << "," << run.two_tape.steps << ","
+                 << run.two_tape.tape_extent << ","
+                 << run_result_name(run.one_tape.result) << "," << run.one_tape.steps << ","
+                 << run.one_tape.tape_extent << "\n";
+        cout << "\nsection,one_tape_steps,share\n";
+        for (const auto &section: section_steps)
+            cout << section.first << "," << section.second << ","
+                 << (total_steps ? (double) section.second / total_steps : 0) << "\n";
+        cout << "\nfit,exponent,coefficient\n"
+             << "one_tape_steps_vs_two_tape_steps,";
+        output_number(cout, fit_steps.first, json);
+        cout << ",";
+        output_number(cout, fit_steps.second, json);
+        cout << "\none_tape_steps_vs_length,";
+        output_number(cout, fit_length.first, json);
+        cout << ",";
+        output_number(cout, fit_length.second, json);
+        cout << "\n";
+    }
+    return 0;
+}
+
+// the simulator reports problems it cannot handle (a machine too large to simulate, a failed file operation)
+// by exceptions
+int main(int argc, char *argv[]) {
+    try {
+        return overhead_main(argc, argv);
+    } catch (const std::exception &e) {
+        cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <string>
+#include "turing_machine.h"
+#include "turing_machine_simulator.h"
+
+using namespace std;
+
+#define DEFAULT_MAX_STEPS 1000000
+#define DEFAULT_CHECKPOINT_INTERVAL 100000000
+
+static void print_usage(const string &error) {
+    cerr << "ERROR: " << error << "\n"
+         << "Usage: tm_simulator [--record-profile <profile_file>] [--use-profile <profile_file>]"
+            " <machine_file> [max_steps] < <inputs>\n"
+         << "   or: tm_simulator --disk <directory> [--checkpoint-interval <steps>] [--resume]"
+            " <machine_file> [max_steps] < <input>\n"
+         << "where <inputs> contains one input word per line, and <input> one input word (not read with --resume)\n";
+    exit(1);
+}
+
+
+static int simulator_main(int argc, char *argv[]) {
+    string machine_filename;
+    string record_profile_filename;
+    string use_profile_filename;
+    string disk_directory;
+    long long checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL;
+    bool resume = false;
+    long long max_steps = DEFAULT_MAX_STEPS;
+    int ok = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--record-profile" || arg == "--use-profile" || arg == "--disk") {
+            if (++i == argc)
+                print_usage("Missing file name after " + arg);
+            (arg == "--record-profile" ? record_profile_filename :
+             arg == "--use-profile" ? use_profile_filename : disk_directory) = argv[i];
+        } else if (arg == "--checkpoint-interval") {
+            try {
+                if (++i == argc)
+                    throw 0;
+                size_t last;
+                checkpoint_interval = stoll(argv[i], &last);
+                if (argv[i][last] != '\0' || checkpoint_interval <= 0)
+                    throw 0;
+            } catch (...) {
+                print_usage("--checkpoint-interval should be followed by a positive integer");
+            }
+        } else if (arg == "--resume") {
+            resume = true;
+        } else if (ok == 0) {
+            machine_filename = arg;
+            ++ok;
+        } else if (ok == 1) {
+            try {
+                size_t last;
+                max_steps = stoll(arg, &last);
+                if (last != arg.length() || max_steps < 0)
+                    throw 0;
+            } catch (...) {
+                print_usage("max_steps should be a nonnegative integer");
+            }
+            ++ok;
+        } else
+            print_usage("Too many arguments");
+    }
+    if (ok == 0)
+        print_usage("Not enough arguments");
+    if (disk_directory.empty() && resume)
+        print_usage("--resume needs --disk");
+    if (!disk_directory.empty() && (!record_profile_filename.empty() || !use_profile_filename.empty()))
+        print_usage("Profiles cannot be used with --disk");
+
+    FILE *f = fopen(machine_filename.c_str(), "r");
+    if (!f) {
+        cerr << "ERROR: File " << machine_filename << " does not exist\n";
+        return 1;
+    }
+    TuringMachine tm = read_tm_from_file(f);
+
+    profile_t profile;
+    if (!use_profile_filename.empty()) {
+        ifstream profile_file(use_profile_filename);
+        if (!profile_file) {
+            cerr << "ERROR: File " << use_profile_filename << " does not exist\n";
+            return 1;
+        }
+        profile = read_profile(profile_file, tm);
+    }
+    // opened only now, so that the same file can be both used and recorded
+    ofstream record_profile_file;
+    if (!record_profile_filename.empty()) {
+        record_profile_file.open(record_profile_filename);
+        if (!record_profile_file) {
+            cerr << "ERROR: Cannot write " << record_profile_filename << "\n";
+            return 1;
+        }
+    }
+    Simulator simulator(tm, profile);
+
+    if (!disk_directory.empty()) {
+        string line;
+        vector<string> input;
+        if (!resume) {
+            getline(cin, line);
+            input = tm.parse_input(line);
+            if (!line.empty() && input.empty()) {
+                cerr << "ERROR: Invalid input \"" << line << "\"\n";
+                return 1;
+            }
+        }
+        RunStats stats = simulator.run_on_disk(input, max_steps, disk_directory, checkpoint_interval, resume);
+        cout << (resume ? "(resumed)" : line.empty() ? "\"\"" : line) << " " << run_result_name(stats.result)
+             << " " << stats.steps << "\n";
+        return 0;
+    }
+
+    vector<long long> hits;
+    if (!record_profile_filename.empty())
+        hits = simulator.empty_hit_counts();
+
+    // one line per input: <input> <result> <steps> [<cycle_length>]
+    long long num_inputs = 0, total_steps = 0;
+    chrono::duration<double> elapsed(0);
+    string line;
+    while (getline(cin, line)) {
+        vector<string> input = tm.parse_input(line);
+        if (!line.empty() && input.empty()) {
+            cerr << "ERROR: Invalid input \"" << line << "\"\n";
+            return 1;
+        }
+        auto start = chrono::steady_clock::now();
+        RunStats stats = simulator.run(input, max_steps, hits.empty() ? nullptr : &hits);
+        elapsed += chrono::steady_clock::now() - start;
+        ++num_inputs;
+        total_steps += stats.steps;
+
+        cout << (line.empty() ? "\"\"" : line) << " " << run_result_name(stats.result) << " " << stats.steps;
+        if (stats.result == RUN_LOOP)
+            cout << " " << stats.cycle_length;
+        cout << "\n";
+    }
+    cerr << num_inputs << " inputs, " << total_steps << " steps in " << elapsed.count() << " s ("
+         << (elapsed.count() > 0 ? total_steps / elapsed.count() : 0) << " steps/s)\n";
+
+    if (!record_profile_filename.empty()) {
+        // the recorded hits are added to the profile that was used, if any
+        simulator.add_to_profile(hits, profile);
+        save_profile(record_profile_file, profile);
+        if (!record_profile_file.flush()) {
+            cerr << "ERROR: Cannot write " << record_profile_filename << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// the simulator reports problems it cannot handle (a machine too large to simulate, a failed file operation)
+// by exceptions
+int main(int argc, char *argv[]) {
+    try {
+        return simulator_main(argc, argv);
+    } catch (const std::exception &e) {
+        cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -111,14 +111,14 @@ TuringMachine::TuringMachine(int num_tapes_, vector<string> input_alphabet_, tra
         : num_tapes(num_tapes_), input_alphabet(std::move(input_alphabet_)), transitions(std::move(transitions_)) {
     assert(num_tapes > 0);
     assert(!input_alphabet.empty());
-    for (auto letter: input_alphabet)
+    for (const auto &letter: input_alphabet)
         assert(is_identifier(letter) && letter != BLANK);
-    for (auto transition: transitions) {
-        auto state_before = transition.first.first;
-        auto letters_before = transition.first.second;
-        auto state_after = get<0>(transition.second);
-        auto letters_after = get<1>(transition.second);
-        auto directions = get<2>(transition.second);
+    for (const auto &transition: transitions) {
+        const auto &state_before = transition.first.first;
+        const auto &letters_before = transition.first.second;
+        const auto &state_after = get<0>(transition.second);
+        const auto &letters_after = get<1>(transition.second);
+        const auto &directions = get<2>(transition.second);
         assert(is_identifier(state_before) && state_before != ACCEPTING_STATE && state_before != REJECTING_STATE &&
                is_identifier(state_after));
         assert(letters_before.size() == (size_t) num_tapes && letters_after.size() == (size_t) num_tapes &&
@@ -232,9 +232,9 @@ TuringMachine read_tm_from_file(FILE *input) {
 vector<string> TuringMachine::working_alphabet() const {
     set<string> letters(input_alphabet.begin(), input_alphabet.end());
     letters.insert(BLANK);
-    for (auto transition: transitions) {
-        auto letters_before = transition.first.second;
-        auto letters_after = get<1>(transition.second);
+    for (const auto &transition: transitions) {
+        const auto &letters_before = transition.first.second;
+        const auto &letters_after = get<1>(transition.second);
         letters.insert(letters_before.begin(), letters_before.end());
         letters.insert(letters_after.begin(), letters_after.end());
     }
@@ -246,7 +246,7 @@ vector<string> TuringMachine::set_of_states() const {
     states.insert(INITIAL_STATE);
     states.insert(ACCEPTING_STATE);
     states.insert(REJECTING_STATE);
-    for (auto transition: transitions) {
+    for (const auto &transition: transitions) {
         states.insert(transition.first.first);
         states.insert(get<0>(transition.second));
     }
@@ -263,12 +263,12 @@ void TuringMachine::save_to_file(ostream &output) const {
            << INPUT_ALPHABET;
     output_vector(output, input_alphabet);
     output << "\n";
-    for (auto transition: transitions) {
+    for (const auto &transition: transitions) {
         output << transition.first.first;
         output_vector(output, transition.first.second);
         output << " " << get<0>(transition.second);
         output_vector(output, get<1>(transition.second));
-        string directions = get<2>(transition.second);
+        const string &directions = get<2>(transition.second);
         for (int a = 0; a < num_tapes; ++a)
             output << " " << directions[a];
         output << "\n";
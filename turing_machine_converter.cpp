@@ -122,67 +122,84 @@ string merge(const string &a, const string &b, const string &c, const string &d)
 }
 
 
-TuringMachine two_tape_to_one_tape(TuringMachine &two_tape_machine) {
+// which part of the converter added a transition (a section name for every key of transitions_t)
+typedef std::map<transitions_t::key_type, std::string> sections_t;
+
+// if sections is given, it gets the section of every transition of the returned machine
+TuringMachine two_tape_to_one_tape(TuringMachine &two_tape_machine, sections_t *sections = nullptr) {
     vector<string> input_alphabet_plus_blank = two_tape_machine.input_alphabet;
     input_alphabet_plus_blank.emplace_back(BLANK);
+    const vector<string> working_alphabet = two_tape_machine.working_alphabet();
+    const vector<string> states = two_tape_machine.set_of_states();
     transitions_t transitions;
 
+    // transitions are added through emit(), which records the current section
+    // (for a transition set twice, the section which set it last)
+    string section;
+    auto emit = [&](const transitions_t::key_type &key) -> transitions_t::mapped_type & {
+        if (sections)
+            (*sections)[key] = section;
+        return transitions[key];
+    };
+
     // special: start
+    section = "start";
     for (const auto &letter: input_alphabet_plus_blank) {
         auto letter_before = vec(letter);
         auto letter_after = vec(enrich(letter, IS_HEAD));
 
-        transitions[make_pair(INITIAL_STATE, letter_before)] = make_tuple(create_state_1, letter_after, HEAD_RIGHT);
+        emit(make_pair(INITIAL_STATE, letter_before)) = make_tuple(create_state_1, letter_after, HEAD_RIGHT);
         ///////////////////////////////
 
         letter_after = vec(enrich(letter, NOTHING_SPECIAL));
 
-        transitions[make_pair(create_state_1, letter_before)] = make_tuple(create_state_1, letter_after, HEAD_RIGHT);
+        emit(make_pair(create_state_1, letter_before)) = make_tuple(create_state_1, letter_after, HEAD_RIGHT);
         ///////////////////////////////
 
         letter_before = vec(BLANK);
         letter_after = vec(HASH);
 
-        transitions[make_pair(create_state_1, letter_before)] = make_tuple(create_state_2, letter_after, HEAD_RIGHT);
+        emit(make_pair(create_state_1, letter_before)) = make_tuple(create_state_2, letter_after, HEAD_RIGHT);
         ///////////////////////////////
 
         letter_before = vec(BLANK);
         letter_after = vec(enrich(BLANK, IS_HEAD));
 
-        transitions[make_pair(create_state_2, letter_before)] = make_tuple(create_state_3, letter_after, HEAD_RIGHT);
+        emit(make_pair(create_state_2, letter_before)) = make_tuple(create_state_3, letter_after, HEAD_RIGHT);
         ///////////////////////////////
 
-        transitions[make_pair(create_state_3, letter_before)] = make_tuple(
+        emit(make_pair(create_state_3, letter_before)) = make_tuple(
                 merge(return_from_start_1, INITIAL_STATE, BLANK),
                 vec(HASH),
                 HEAD_LEFT);
     }
 
     // special: return from start
+    section = "return from start";
     {
         // jump one marked blank (we just created it)
-        transitions[make_pair(merge(return_from_start_1, INITIAL_STATE, BLANK), vec(enrich(BLANK, IS_HEAD)))] =
+        emit(make_pair(merge(return_from_start_1, INITIAL_STATE, BLANK), vec(enrich(BLANK, IS_HEAD)))) =
                 make_tuple(merge(return_from_start_2, INITIAL_STATE, BLANK), vec(enrich(BLANK, IS_HEAD)), HEAD_LEFT);
 
-        for (const auto &letter: two_tape_machine.working_alphabet()) {
+        for (const auto &letter: working_alphabet) {
             auto letter_before = vec(enrich(letter, NOTHING_SPECIAL));
-            transitions[make_pair(merge(return_from_start_2, INITIAL_STATE, BLANK), letter_before)] =
+            emit(make_pair(merge(return_from_start_2, INITIAL_STATE, BLANK), letter_before)) =
                     make_tuple(merge(return_from_start_2, INITIAL_STATE, BLANK), letter_before, HEAD_LEFT);
 
-            transitions[make_pair(merge(return_from_start_2, INITIAL_STATE, BLANK), vec(HASH))] =
+            emit(make_pair(merge(return_from_start_2, INITIAL_STATE, BLANK), vec(HASH))) =
                     make_tuple(merge(return_from_start_2, INITIAL_STATE, BLANK), vec(HASH), HEAD_LEFT);
 
             letter_before = vec(enrich(letter, IS_HEAD));
             auto letter_after = vec(enrich(letter, NOTHING_SPECIAL));
 
-            transitions[make_pair(merge(return_from_start_2, INITIAL_STATE, BLANK), letter_before)] =
+            emit(make_pair(merge(return_from_start_2, INITIAL_STATE, BLANK), letter_before)) =
                     make_tuple(merge(INITIAL_STATE, BLANK), letter_after, HEAD_STAY);
         }
     }
 
     // general case
-    for (auto transition: two_tape_machine.transitions) {
-        string q1 = transition.first.first;
+    for (const auto &transition: two_tape_machine.transitions) {
+        const string &q1 = transition.first.first;
         if (q1 == ACCEPTING_STATE || q1 == REJECTING_STATE)
             continue;
         string c1 = transition.first.second[0];
@@ -194,152 +211,160 @@ TuringMachine two_tape_to_one_tape(TuringMachine &two_tape_machine) {
         string d2 = string(1, get<2>(transition.second)[1]);
 
         string c1_with_dir = enrich(c1p, dir_to_enrichment(d1));
+        section = "general case: go to 2nd tape head";
         {
             auto letter_before = vec(enrich(c1, NOTHING_SPECIAL));
             auto letter_after = vec(c1_with_dir);
 
             // 1
-            transitions[make_pair(merge(q1, c2), letter_before)] =
+            emit(make_pair(merge(q1, c2), letter_before)) =
                     make_tuple(merge(q2, c2p, string(1, dir_to_enrichment(d2))), letter_after, HEAD_RIGHT);
         }
         ///////////////////////////////
         auto state = merge(q2, c2p, string(1, dir_to_enrichment(d2)));
-        for (const auto &letter: two_tape_machine.working_alphabet()) {
+        for (const auto &letter: working_alphabet) {
             auto letter_before = vec(enrich(letter, NOTHING_SPECIAL));
             // 2
-            transitions[make_pair(state, letter_before)] =
+            emit(make_pair(state, letter_before)) =
                     make_tuple(state, letter_before, HEAD_RIGHT);
         }
 
         // 2 (hash)
-        transitions[make_pair(state, vec(HASH))] =
+        emit(make_pair(state, vec(HASH))) =
                 make_tuple(state, vec(HASH), HEAD_RIGHT);
 
         ///////////////////////////////
-        for (const auto &letter: two_tape_machine.working_alphabet()) {
+        section = "general case: update 2nd tape";
+        for (const auto &letter: working_alphabet) {
             auto letter_before = vec(enrich(letter, IS_HEAD));
             auto letter_after = vec(enrich(c2p, NOTHING_SPECIAL));
             // 3
-            transitions[make_pair(state, letter_before)] =
+            emit(make_pair(state, letter_before)) =
                     make_tuple(merge(mark_return_state, q2, c2p, string(1, dir_to_enrichment(d2))), letter_after, d2);
         }
 
         ///////////////////////////////
-        for (const auto &letter_to_mark: two_tape_machine.working_alphabet()) {
+        for (const auto &letter_to_mark: working_alphabet) {
             auto letter_before = vec(enrich(letter_to_mark, NOTHING_SPECIAL));
             auto letter_after = vec(enrich(letter_to_mark, IS_HEAD));
 
             // 4
-            transitions[make_pair(merge(mark_return_state, q2, c2p, string(1, dir_to_enrichment(d2))), letter_before)] =
+            section = "general case: mark 2nd tape head";
+            emit(make_pair(merge(mark_return_state, q2, c2p, string(1, dir_to_enrichment(d2))), letter_before)) =
                     make_tuple(merge(return_state, q2, letter_to_mark), letter_after, HEAD_LEFT);
 
 
             ///////////////////////////////
-            for (const auto &letter: two_tape_machine.working_alphabet()) {
+            section = "general case: return to 1st tape head";
+            for (const auto &letter: working_alphabet) {
                 letter_before = vec(enrich(letter, NOTHING_SPECIAL));
 
                 // 5
-                transitions[make_pair(merge(return_state, q2, letter_to_mark), letter_before)] =
+                emit(make_pair(merge(return_state, q2, letter_to_mark), letter_before)) =
                         make_tuple(merge(return_state, q2, letter_to_mark), letter_before, HEAD_LEFT);
 
                 letter_before = vec(enrich(letter, IS_HEAD));
 
                 // 5 (marked, but ignore mark)
-                transitions[make_pair(merge(return_state, q2, letter_to_mark), letter_before)] =
+                emit(make_pair(merge(return_state, q2, letter_to_mark), letter_before)) =
                         make_tuple(merge(return_state, q2, letter_to_mark), letter_before, HEAD_LEFT);
             }
 
 
             // 5 (hash)
-            transitions[make_pair(merge(return_state, q2, letter_to_mark), vec(HASH))] =
+            emit(make_pair(merge(return_state, q2, letter_to_mark), vec(HASH))) =
                     make_tuple(merge(return_state, q2, letter_to_mark), vec(HASH), HEAD_LEFT);
 
             ///////////////////////////////
             // 6
-            transitions[make_pair(merge(return_state, q2, letter_to_mark), vec(c1_with_dir))] =
+            emit(make_pair(merge(return_state, q2, letter_to_mark), vec(c1_with_dir))) =
                     make_tuple(merge(q2, letter_to_mark), vec(enrich(c1p, NOTHING_SPECIAL)), d1);
         }
     }
 
     // special: 1st tape no space
-    for (const auto &state: two_tape_machine.set_of_states()) {
-        for (const auto &letter: two_tape_machine.working_alphabet()) {
+    section = "1st tape no space";
+    for (const auto &state: states) {
+        for (const auto &letter: working_alphabet) {
             // 0
-            transitions[make_pair(merge(state, letter), vec(HASH))] =
+            emit(make_pair(merge(state, letter), vec(HASH))) =
                     make_tuple(merge(move_state, state), vec(enrich(BLANK, GO_STAY)), HEAD_RIGHT);
 
             for (char enrichment1: letter_enrichment_no_directions) {
                 string on_tape_letter = enrich(letter, enrichment1);
 
                 // 1
-                transitions[make_pair(merge(move_state, state), vec(on_tape_letter))] =
+                emit(make_pair(merge(move_state, state), vec(on_tape_letter))) =
                         make_tuple(merge(move_state, state, on_tape_letter), vec(HASH), HEAD_RIGHT);
 
-                for (const auto &letter2: two_tape_machine.working_alphabet()) {
+                for (const auto &letter2: working_alphabet) {
                     for (char enrichment2: letter_enrichment_no_directions) {
                         string on_tape_letter2 = enrich(letter2, enrichment2);
 
                         // 2
-                        transitions[make_pair(merge(move_state, state, on_tape_letter), vec(on_tape_letter2))] =
+                        emit(make_pair(merge(move_state, state, on_tape_letter), vec(on_tape_letter2))) =
                                 make_tuple(merge(move_state, state, on_tape_letter2), vec(on_tape_letter), HEAD_RIGHT);
                     }
                 }
 
                 // 2 (hash)
-                transitions[make_pair(merge(move_state, state, on_tape_letter), vec(HASH))] =
+                emit(make_pair(merge(move_state, state, on_tape_letter), vec(HASH))) =
                         make_tuple(merge(move_state, state, HASH), vec(on_tape_letter), HEAD_RIGHT);
 
                 // 3
-                transitions[make_pair(merge(move_state, state, HASH), vec(BLANK))] =
+                emit(make_pair(merge(move_state, state, HASH), vec(BLANK))) =
                         make_tuple(merge(return_state, state), vec(HASH), HEAD_LEFT);
             }
             // 4
             for (char enrichment_no_mark: letter_enrichment_no_mark) {
                 string on_tape_letter_not_marked = enrich(letter, enrichment_no_mark);
 
-                transitions[make_pair(merge(return_state, state), vec(on_tape_letter_not_marked))] =
+                emit(make_pair(merge(return_state, state), vec(on_tape_letter_not_marked))) =
                         make_tuple(merge(return_state, state), vec(on_tape_letter_not_marked), HEAD_LEFT);
             }
 
             string on_tape_letter_marked = enrich(letter, IS_HEAD);
 
             // 5
-            transitions[make_pair(merge(return_state, state), vec(on_tape_letter_marked))] =
+            emit(make_pair(merge(return_state, state), vec(on_tape_letter_marked))) =
                     make_tuple(merge(return_state, state, letter), vec(on_tape_letter_marked), HEAD_LEFT);
         }
     }
 
     // special: 2nd tape no space
-    for (const auto &state: two_tape_machine.set_of_states()) {
-        for (const auto &letter: two_tape_machine.working_alphabet()) {
-            transitions[make_pair(merge(mark_return_state, state, letter, string(1, GO_STAY)), vec(HASH))] =
+    section = "2nd tape no space";
+    for (const auto &state: states) {
+        for (const auto &letter: working_alphabet) {
+            emit(make_pair(merge(mark_return_state, state, letter, string(1, GO_STAY)), vec(HASH))) =
                     make_tuple(merge(extend_state, state), vec(enrich(BLANK, IS_HEAD)), HEAD_RIGHT);
 
-            transitions[make_pair(merge(mark_return_state, state, letter, string(1, GO_RIGHT)), vec(HASH))] =
+            emit(make_pair(merge(mark_return_state, state, letter, string(1, GO_RIGHT)), vec(HASH))) =
                     make_tuple(merge(extend_state, state), vec(enrich(BLANK, IS_HEAD)), HEAD_RIGHT);
         }
 
-        transitions[make_pair(merge(extend_state, state), vec(BLANK))] =
+        emit(make_pair(merge(extend_state, state), vec(BLANK))) =
                 make_tuple(merge(return_state, state), vec(HASH), HEAD_LEFT);
     }
 
     // special: fall off second tape
-    for (const auto &state: two_tape_machine.set_of_states()) {
-        for (const auto &letter: two_tape_machine.working_alphabet()) {
-            transitions[make_pair(merge(mark_return_state, state, letter, string(1, GO_LEFT)), vec(HASH))] =
+    section = "fall off second tape";
+    for (const auto &state: states) {
+        for (const auto &letter: working_alphabet) {
+            emit(make_pair(merge(mark_return_state, state, letter, string(1, GO_LEFT)), vec(HASH))) =
                     make_tuple(REJECTING_STATE, vec(HASH), HEAD_STAY);
         }
     }
 
     // return state to base case
-    for (const auto &state: two_tape_machine.set_of_states()) {
-        for (const auto &state_letter: two_tape_machine.working_alphabet()) {
-            for (const auto &tape_letter: two_tape_machine.working_alphabet()) {
+    section = "return state to base case";
+    for (const auto &state: states) {
+        for (const auto &state_letter: working_alphabet) {
+            for (const auto &tape_letter: working_alphabet) {
                 for (char enrichmentDirection: letter_enrichment_directions) {
                     string on_tape_letter_before = enrich(tape_letter, enrichmentDirection);
                     string on_tape_letter_after = enrich(tape_letter, NOTHING_SPECIAL);
 
-                    transitions[make_pair(merge(return_state, state, state_letter), vec(on_tape_letter_before))] =
+                    emit(make_pair(merge(return_state, state, state_letter), vec(on_tape_letter_before))) =
                             make_tuple(merge(state, state_letter), vec(on_tape_letter_after),
                                        enrichment_to_dir(enrichmentDirection));
                 }
@@ -348,14 +373,15 @@ TuringMachine two_tape_to_one_tape(TuringMachine &two_tape_machine) {
     }
 
     // special: accept/reject
-    for (const auto &letter1: two_tape_machine.working_alphabet()) {
-        for (const auto &letter2: two_tape_machine.working_alphabet()) {
+    section = "accept/reject";
+    for (const auto &letter1: working_alphabet) {
+        for (const auto &letter2: working_alphabet) {
             auto letter_on_tape = enrich(letter1, NOTHING_SPECIAL);
 
-            transitions[make_pair(merge(ACCEPTING_STATE, letter2), vec(letter_on_tape))] =
+            emit(make_pair(merge(ACCEPTING_STATE, letter2), vec(letter_on_tape))) =
                     make_tuple(ACCEPTING_STATE, vec(letter_on_tape), HEAD_STAY);
 
-            transitions[make_pair(merge(REJECTING_STATE, letter2), vec(letter_on_tape))] =
+            emit(make_pair(merge(REJECTING_STATE, letter2), vec(letter_on_tape))) =
                     make_tuple(REJECTING_STATE, vec(letter_on_tape), HEAD_STAY);
         }
     }
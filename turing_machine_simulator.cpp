@@ -0,0 +1,537 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "turing_machine_simulator.h"
+
+using namespace std;
+
+const char *run_result_name(run_result_t result) {
+    switch (result) {
+        case RUN_ACCEPT:
+            return "accept";
+        case RUN_REJECT:
+            return "reject";
+        case RUN_LOOP:
+            return "loop";
+        case RUN_BUDGET_EXHAUSTED:
+            return "budget-exhausted";
+    }
+    return "?";
+}
+
+// the finalizer of splitmix64
+static uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// whether two tapes hold the same letters, ignoring blanks at the end
+static bool same_tape(const vector<int> &a, const vector<int> &b) {
+    const vector<int> &shorter = a.size() < b.size() ? a : b;
+    const vector<int> &longer = a.size() < b.size() ? b : a;
+    for (size_t pos = 0; pos < shorter.size(); ++pos)
+        if (shorter[pos] != longer[pos])
+            return false;
+    for (size_t pos = shorter.size(); pos < longer.size(); ++pos)
+        if (longer[pos] != 0)
+            return false;
+    return true;
+}
+
+Simulator::Simulator(const TuringMachine &tm, const profile_t &profile)
+        : num_tapes(tm.num_tapes), entry_size(1 + tm.num_tapes) {
+    map<string, long long> letter_hits, state_hits;
+    for (const auto &entry: profile) {
+        state_hits[entry.first.first] += entry.second;
+        for (const auto &letter: entry.first.second)
+            letter_hits[letter] += entry.second;
+    }
+
+    // the blank letter stays 0, so that blank cells do not contribute to the tape hash
+    for (const auto &letter: tm.working_alphabet())
+        if (letter != BLANK)
+            letters.emplace_back(letter);
+    stable_sort(letters.begin(), letters.end(), [&letter_hits](const string &a, const string &b) {
+        return letter_hits[a] > letter_hits[b];
+    });
+    letters.insert(letters.begin(), BLANK);
+    for (size_t a = 0; a < letters.size(); ++a)
+        letter_ids[letters[a]] = (int) a;
+
+    states = tm.set_of_states();
+    stable_sort(states.begin(), states.end(), [&state_hits](const string &a, const string &b) {
+        return state_hits[a] > state_hits[b];
+    });
+    map<string, int> state_ids;
+    for (size_t a = 0; a < states.size(); ++a)
+        state_ids[states[a]] = (int) a;
+    initial_state = state_ids[INITIAL_STATE];
+    accepting_state = state_ids[ACCEPTING_STATE];
+    rejecting_state = state_ids[REJECTING_STATE];
+
+    num_hot_states = (int) states.size();
+    if (!profile.empty())
+        num_hot_states = (int) count_if(states.begin(), states.end(), [&state_hits](const string &state) {
+            return state_hits[state] > 0;
+        });
+
+    row_size = 1;
+    for (int a = 0; a < num_tapes; ++a) {
+        if (row_size * max(num_hot_states, 1) > (size_t(1) << 28) / letters.size())
+            throw std::runtime_error("Simulator: transition table of the machine is too large");
+        row_size *= letters.size();
+    }
+    hot_table.assign(num_hot_states * row_size * entry_size, 0);
+    for (size_t index = 0; index < num_hot_states * row_size; ++index)
+        hot_table[index * entry_size] = -1;
+
+    for (const auto &transition: tm.transitions) {
+        int state = state_ids[transition.first.first];
+        size_t index = 0;
+        for (int a = num_tapes - 1; a >= 0; --a)
+            index = index * letters.size() + letter_ids[transition.first.second[a]];
+        index += state * row_size;
+
+        int *entry;
+        if (state < num_hot_states) {
+            entry = &hot_table[index * entry_size];
+        } else {
+            cold_positions[index] = cold_indices.size();
+            cold_indices.push_back(index);
+            cold_table.resize(cold_table.size() + entry_size);
+            entry = &cold_table[cold_table.size() - entry_size];
+        }
+        entry[0] = state_ids[get<0>(transition.second)];
+        for (int a = 0; a < num_tapes; ++a) {
+            char direction = get<2>(transition.second)[a];
+            int move = direction == HEAD_LEFT ? -1 : direction == HEAD_RIGHT ? 1 : 0;
+            entry[1 + a] = letter_ids[get<1>(transition.second)[a]] * 4 + (move + 1);
+        }
+    }
+}
+
+template<int K, typename Tape>
+size_t Simulator::table_index(const Configuration<Tape> &conf) const {
+    const int k = K ? K : num_tapes;
+    size_t index = 0;
+    for (int a = k - 1; a >= 0; --a)
+        index = index * letters.size() + conf.tapes[a][conf.heads[a]];
+    return index + conf.state * row_size;
+}
+
+pair<string, vector<string>> Simulator::transition_key(size_t index) const {
+    string state = states[index / row_size];
+    vector<string> letters_before;
+    for (int a = 0; a < num_tapes; ++a) {
+        letters_before.emplace_back(letters[index % letters.size()]);
+        index /= letters.size();
+    }
+    return make_pair(state, letters_before);
+}
+
+// hits[index] for transitions from hot states, hits[num_hot_states * row_size + position] for cold ones
+vector<long long> Simulator::empty_hit_counts() const {
+    return vector<long long>(num_hot_states * row_size + cold_indices.size(), 0);
+}
+
+void Simulator::add_to_profile(const vector<long long> &hits, profile_t &profile) const {
+    assert(hits.size() == num_hot_states * row_size + cold_indices.size());
+    for (size_t slot = 0; slot < hits.size(); ++slot) {
+        if (hits[slot] == 0)
+            continue;
+        size_t index = slot < num_hot_states * row_size ? slot : cold_indices[slot - num_hot_states * row_size];
+        profile[transition_key(index)] += hits[slot];
+    }
+}
+
+// contribution of a single cell to the tape hash; blank cells contribute nothing,
+// so that growing a tape does not change the hash
+uint64_t Simulator::cell_hash(int tape, long long pos, int letter) const {
+    if (letter == 0)
+        return 0;
+    return mix(((uint64_t) pos * num_tapes + tape) * letters.size() + letter);
+}
+
+template<int K>
+uint64_t Simulator::configuration_hash(const Configuration<vector<int>> &conf) const {
+    const int k = K ? K : num_tapes;
+    uint64_t hash = mix(conf.tape_hash ^ (uint64_t) conf.state);
+    for (int a = 0; a < k; ++a)
+        hash = mix(hash ^ (uint64_t) conf.heads[a]);
+    return hash;
+}
+
+template<typename Tape>
+static RunStats finish(RunStats stats, const vector<Tape> &tapes) {
+    for (const auto &tape: tapes)
+        stats.tape_extent = max(stats.tape_extent, (long long) tape.size());
+    return stats;
+}
+
+// the tapes should be empty
+template<typename Tape>
+void Simulator::load_input(const vector<string> &input, Configuration<Tape> &conf) const {
+    conf.state = initial_state;
+    conf.heads.assign(num_tapes, 0);
+    conf.tape_hash = 0;
+    for (const auto &letter: input) {
+        auto it = letter_ids.find(letter);
+        assert(it != letter_ids.end());
+        conf.tapes[0].push_back(it->second);
+        conf.tape_hash += cell_hash(0, (long long) conf.tapes[0].size() - 1, it->second);
+    }
+    for (auto &tape: conf.tapes)
+        if (tape.size() == 0)
+            tape.push_back(0);
+}
+
+template<int K, typename Tape>
+bool Simulator::step(Configuration<Tape> &conf, long long max_steps, RunStats &stats, vector<long long> *hits) const {
+    const int k = K ? K : num_tapes;
+    const int entry_size = 1 + k;
+    if (conf.state == accepting_state) {
+        stats.result = RUN_ACCEPT;
+        return false;
+    }
+    if (conf.state == rejecting_state) {
+        stats.result = RUN_REJECT;
+        return false;
+    }
+    if (stats.steps >= max_steps) {
+        stats.result = RUN_BUDGET_EXHAUSTED;
+        return false;
+    }
+
+    size_t index = table_index<K>(conf);
+    const int *entry = nullptr;
+    size_t slot = index;
+    if (conf.state < num_hot_states) {
+        if (hot_table[index * entry_size] >= 0)
+            entry = &hot_table[index * entry_size];
+    } else {
+        auto it = cold_positions.find(index);
+        if (it != cold_positions.end()) {
+            entry = &cold_table[it->second * entry_size];
+            slot = num_hot_states * row_size + it->second;
+        }
+    }
+    if (!entry) {
+        stats.result = RUN_REJECT;
+        return false;
+    }
+    if (hits)
+        ++(*hits)[slot];
+
+    ++stats.steps;
+    conf.state = entry[0];
+    for (int a = 0; a < k; ++a) {
+        Tape &tape = conf.tapes[a];
+        long long &head = conf.heads[a];
+        int letter = entry[1 + a] >> 2;
+        // reading through a const reference does not mark a page of a MappedTape as dirty,
+        // so only the cells which really change are written
+        int old_letter = static_cast<const Tape &>(tape)[head];
+        if (letter != old_letter) {
+            conf.tape_hash += cell_hash(a, head, letter) - cell_hash(a, head, old_letter);
+            tape[head] = letter;
+        }
+        head += (entry[1 + a] & 3) - 1;
+        if (head < 0) {
+            stats.result = RUN_REJECT;
+            return false;
+        }
+        if ((size_t) head == tape.size())
+            tape.push_back(0);
+    }
+    return true;
+}
+
+// Cycle detection follows Brent: one configuration is kept as a checkpoint and compared (by hash first)
+// with every later one; the checkpoint is replaced after 1, 2, 4, 8, ... steps. Once the run is inside
+// a cycle of length L, the repetition is found within about 2L further steps, and only one copy
+// of the tapes is kept.
+RunStats Simulator::run(const vector<string> &input, long long max_steps, vector<long long> *hits) const {
+    switch (num_tapes) {
+        case 1:
+            return run_with_tapes<1>(input, max_steps, hits);
+        case 2:
+            return run_with_tapes<2>(input, max_steps, hits);
+        default:
+            return run_with_tapes<0>(input, max_steps, hits);
+    }
+}
+
+template<int K>
+RunStats Simulator::run_with_tapes(const vector<string> &input, long long max_steps, vector<long long> *hits) const {
+    const int k = K ? K : num_tapes;
+    Configuration<vector<int>> conf;
+    conf.tapes.resize(num_tapes);
+    load_input(input, conf);
+
+    Configuration<vector<int>> checkpoint = conf;
+    uint64_t checkpoint_hash = configuration_hash<K>(conf);
+    long long power = 1, lambda = 0;
+
+    RunStats stats = {RUN_BUDGET_EXHAUSTED, 0, 0, 0};
+    while (step<K>(conf, max_steps, stats, hits)) {
+        ++lambda;
+        uint64_t hash = configuration_hash<K>(conf);
+        if (hash == checkpoint_hash && conf.state == checkpoint.state && conf.heads == checkpoint.heads) {
+            bool same = true;
+            for (int a = 0; a < k && same; ++a)
+                same = same_tape(conf.tapes[a], checkpoint.tapes[a]);
+            if (same) {
+                stats.result = RUN_LOOP;
+                stats.cycle_length = lambda;
+                break;
+            }
+        }
+        if (lambda == power) {
+            checkpoint = conf;
+            checkpoint_hash = hash;
+            power *= 2;
+            lambda = 0;
+        }
+    }
+    return finish(stats, conf.tapes);
+}
+
+RunStats Simulator::run_on_disk(const vector<string> &input, long long max_steps, const string &directory,
+                                long long checkpoint_interval, bool resume) const {
+    assert(checkpoint_interval > 0);
+    switch (num_tapes) {
+        case 1:
+            return run_on_disk_with_tapes<1>(input, max_steps, directory, checkpoint_interval, resume);
+        case 2:
+            return run_on_disk_with_tapes<2>(input, max_steps, directory, checkpoint_interval, resume);
+        default:
+            return run_on_disk_with_tapes<0>(input, max_steps, directory, checkpoint_interval, resume);
+    }
+}
+
+static string tape_filename(const string &directory, int tape) {
+    return directory + "/tape" + to_string(tape);
+}
+
+template<int K>
+RunStats Simulator::run_on_disk_with_tapes(const vector<string> &input, long long max_steps, const string &directory,
+                                           long long checkpoint_interval, bool resume) const {
+    Configuration<MappedTape> conf;
+    RunStats stats = {RUN_BUDGET_EXHAUSTED, 0, 0, 0};
+    if (resume) {
+        read_checkpoint(directory, conf, stats.steps);
+    } else {
+        for (int a = 0; a < num_tapes; ++a)
+            conf.tapes.emplace_back(tape_filename(directory, a), true);
+        load_input(input, conf);
+        write_checkpoint(directory, conf, stats.steps);
+    }
+
+    if (*min_element(conf.heads.begin(), conf.heads.end()) < 0) {
+        // the run ended by a head falling off the tape
+        stats.result = RUN_REJECT;
+        return finish(stats, conf.tapes);
+    }
+
+    long long next_checkpoint = stats.steps + checkpoint_interval;
+    while (step<K>(conf, max_steps, stats, nullptr)) {
+        if (stats.steps == next_checkpoint) {
+            write_checkpoint(directory, conf, stats.steps);
+            next_checkpoint += checkpoint_interval;
+        }
+    }
+    write_checkpoint(directory, conf, stats.steps);
+    return finish(stats, conf.tapes);
+}
+
+// A checkpoint is a text header:
+//   num-tapes: <k>
+//   page-size: <cells per page>
+//   letters: <letter 0> <letter 1> ...
+//   state: <state>
+//   steps: <steps>
+//   tape: <head> <length>              (k lines)
+//   pages: <n>
+// followed by n binary records: tape number and page number (as uint64_t), then the contents of the page.
+// These are the pages changed since the previous checkpoint; they are written to the tape files only after
+// the checkpoint is safely on disk, so the tape files never run ahead of the checkpoint, and resuming
+// writes them again in case the previous run was stopped in the middle.
+void Simulator::write_checkpoint(const string &directory, Configuration<MappedTape> &conf, long long steps) const {
+    string filename = directory + "/checkpoint";
+    string tmp_filename = filename + ".tmp";
+    {
+        ofstream output(tmp_filename, ios::binary | ios::trunc);
+        output << "num-tapes: " << num_tapes << "\n"
+               << "page-size: " << conf.tapes[0].cells_per_page() << "\n"
+               << "letters:";
+        for (const auto &letter: letters)
+            output << " " << letter;
+        output << "\n"
+               << "state: " << states[conf.state] << "\n"
+               << "steps: " << steps << "\n";
+        size_t num_pages = 0;
+        for (int a = 0; a < num_tapes; ++a) {
+            output << "tape: " << conf.heads[a] << " " << conf.tapes[a].size() << "\n";
+            num_pages += conf.tapes[a].dirty_pages().size();
+        }
+        output << "pages: " << num_pages << "\n";
+        for (int a = 0; a < num_tapes; ++a) {
+            for (size_t index: conf.tapes[a].dirty_pages()) {
+                uint64_t header[2] = {(uint64_t) a, (uint64_t) index};
+                output.write((const char *) header, sizeof(header));
+                output.write((const char *) conf.tapes[a].page(index), conf.tapes[a].cells_per_page() * sizeof(int));
+            }
+        }
+        if (!output.flush())
+            throw std::runtime_error("Cannot write " + tmp_filename);
+    }
+    MappedTape::sync_file(tmp_filename);
+    if (rename(tmp_filename.c_str(), filename.c_str()) != 0)
+        throw std::runtime_error("Cannot write " + filename);
+    MappedTape::sync_file(directory);
+
+    for (auto &tape: conf.tapes)
+        tape.write_back();
+}
+
+[[noreturn]] static void checkpoint_error(const string &filename, const string &message) {
+    cerr << "Invalid checkpoint " << filename << ": " << message << "\n";
+    exit(1);
+}
+
+// reads "<key> <value>" from a line of the checkpoint header
+static string read_header_line(istream &input, const string &filename, const string &key) {
+    string line;
+    if (!getline(input, line) || line.compare(0, key.length() + 1, key + " ") != 0)
+        checkpoint_error(filename, "\"" + key + "\" expected");
+    return line.substr(key.length() + 1);
+}
+
+static long long read_header_number(istream &input, const string &filename, const string &key) {
+    string value = read_header_line(input, filename, key);
+    try {
+        size_t last;
+        long long res = stoll(value, &last);
+        if (last != value.length() || res < 0)
+            throw 0;
+        return res;
+    } catch (...) {
+        checkpoint_error(filename, "nonnegative integer expected after \"" + key + "\"");
+    }
+}
+
+void Simulator::read_checkpoint(const string &directory, Configuration<MappedTape> &conf, long long &steps) const {
+    string filename = directory + "/checkpoint";
+    ifstream input(filename, ios::binary);
+    if (!input)
+        checkpoint_error(filename, "cannot open");
+
+    if (read_header_line(input, filename, "num-tapes:") != to_string(num_tapes))
+        checkpoint_error(filename, "saved for a different number of tapes");
+    size_t cells_per_page = read_header_number(input, filename, "page-size:");
+    if (cells_per_page != MappedTape::system_cells_per_page())
+        checkpoint_error(filename, "saved with a different page size");
+    string saved_letters;
+    for (const auto &letter: letters)
+        saved_letters += " " + letter;
+    if (" " + read_header_line(input, filename, "letters:") != saved_letters)
+        checkpoint_error(filename, "saved for a different machine");
+
+    string state = read_header_line(input, filename, "state:");
+    auto it = find(states.begin(), states.end(), state);
+    if (it == states.end())
+        checkpoint_error(filename, "saved for a different machine");
+    conf.state = (int) (it - states.begin());
+    steps = read_header_number(input, filename, "steps:");
+
+    vector<size_t> lengths;
+    conf.heads.clear();
+    for (int a = 0; a < num_tapes; ++a) {
+        istringstream tape(read_header_line(input, filename, "tape:"));
+        long long head;
+        size_t length;
+        if (!(tape >> head >> length))
+            checkpoint_error(filename, "head and length of a tape expected");
+        // a head of -1 means that it fell off the tape, which ended the run
+        if (length == 0 || head < -1 || head >= (long long) length)
+            checkpoint_error(filename, "head outside of its tape");
+        conf.heads.push_back(head);
+        lengths.push_back(length);
+    }
+
+    // bring the tape files to the state of the checkpoint
+    size_t num_pages = read_header_number(input, filename, "pages:");
+    vector<map<size_t, vector<int>>> pages(num_tapes);
+    for (size_t a = 0; a < num_pages; ++a) {
+        uint64_t header[2];
+        vector<int> page(cells_per_page);
+        input.read((char *) header, sizeof(header));
+        input.read((char *) page.data(), cells_per_page * sizeof(int));
+        if (!input)
+            checkpoint_error(filename, "truncated");
+        if (header[0] >= (uint64_t) num_tapes
+            || header[1] >= (lengths[header[0]] + cells_per_page - 1) / cells_per_page)
+            checkpoint_error(filename, "page outside of the tapes");
+        for (int letter: page)
+            if (letter < 0 || letter >= (int) letters.size())
+                checkpoint_error(filename, "unknown letter on a tape");
+        pages[header[0]][header[1]] = std::move(page);
+    }
+    for (int a = 0; a < num_tapes; ++a)
+        if (!pages[a].empty())
+            MappedTape::write_pages(tape_filename(directory, a), pages[a]);
+
+    conf.tapes.clear();
+    for (int a = 0; a < num_tapes; ++a) {
+        conf.tapes.emplace_back(tape_filename(directory, a), false);
+        conf.tapes[a].resize(lengths[a]);
+    }
+    conf.tape_hash = 0; // not used without cycle detection
+}
+
+void save_profile(ostream &output, const profile_t &profile) {
+    for (const auto &entry: profile) {
+        output << entry.first.first;
+        for (const auto &letter: entry.first.second)
+            output << " " << letter;
+        output << " " << entry.second << "\n";
+    }
+}
+
+profile_t read_profile(istream &input, const TuringMachine &tm) {
+    profile_t profile;
+    string line;
+    int line_num = 0;
+    while (getline(input, line)) {
+        ++line_num;
+        istringstream tokens(line);
+        string state;
+        if (!(tokens >> state))
+            continue;
+        vector<string> letters(tm.num_tapes);
+        long long hits;
+        string extra;
+        for (auto &letter: letters)
+            tokens >> letter;
+        if (!(tokens >> hits) || hits < 0 || (tokens >> extra)) {
+            cerr << "Invalid profile in line " << line_num << "\n";
+            exit(1);
+        }
+        // a profile recorded for another machine would only reorder the table at random
+        if (tm.transitions.count(make_pair(state, letters)) == 0) {
+            cerr << "Invalid profile in line " << line_num << ": the machine has no transition from this state "
+                    "and letters\n";
+            exit(1);
+        }
+        profile[make_pair(state, letters)] += hits;
+    }
+    return profile;
+}
@@ -0,0 +1,129 @@
+#ifndef __TURING_MACHINE_SIMULATOR_H
+#define __TURING_MACHINE_SIMULATOR_H
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include "mapped_tape.h"
+#include "turing_machine.h"
+
+// tapes are infinite to the right only; every head starts on the leftmost cell,
+// the input is written on the first tape, all other cells are blank
+
+// how a run ended:
+enum run_result_t {
+    RUN_ACCEPT,           // reached the accepting state
+    RUN_REJECT,           // reached the rejecting state, had no transition or a head fell off the left end
+    RUN_LOOP,             // a configuration repeated, so the machine never halts
+    RUN_BUDGET_EXHAUSTED  // no verdict within the given number of steps
+};
+
+const char *run_result_name(run_result_t result);
+
+struct RunStats {
+    run_result_t result;
+    long long steps;
+    long long tape_extent;  // length of the longest tape, counting the input and every cell visited
+    long long cycle_length; // only for RUN_LOOP: number of steps after which the configuration repeats
+};
+
+typedef
+std::map<
+        std::pair<std::string, std::vector<std::string>>, // state, letters
+        long long // how many times the transition was taken
+> profile_t;
+
+// a profile is saved one transition per line: <state> <letter_1> ... <letter_k> <hits>
+void save_profile(std::ostream &output, const profile_t &profile);
+
+// every entry must be a transition of the machine
+profile_t read_profile(std::istream &input, const TuringMachine &tm);
+
+class Simulator {
+public:
+    // with a nonempty profile, states and letters are renumbered hottest first, and only the states
+    // taken at least once in the profile get rows in the dense table; the others go to a secondary table
+    explicit Simulator(const TuringMachine &tm, const profile_t &profile = profile_t());
+
+    // input must be a valid word, as returned by TuringMachine::parse_input;
+    // if hits is given (see empty_hit_counts), the transitions taken are counted there
+    RunStats run(const std::vector<std::string> &input, long long max_steps,
+                 std::vector<long long> *hits = nullptr) const;
+
+    std::vector<long long> empty_hit_counts() const;
+
+    void add_to_profile(const std::vector<long long> &hits, profile_t &profile) const;
+
+    // runs with the tapes kept in files <directory>/tape<a> (see MappedTape), so that only the part of them
+    // in use stays in memory; every checkpoint_interval steps, and when the run ends, a checkpoint is saved
+    // to <directory>/checkpoint; with resume, the input is ignored and the run continues from that checkpoint
+    // (steps and max_steps count from the very beginning of the run); loops are not detected
+    RunStats run_on_disk(const std::vector<std::string> &input, long long max_steps, const std::string &directory,
+                         long long checkpoint_interval, bool resume) const;
+
+private:
+    template<typename Tape>
+    struct Configuration {
+        int state;
+        std::vector<long long> heads;
+        std::vector<Tape> tapes;
+        uint64_t tape_hash;
+    };
+
+    int num_tapes;
+
+    std::vector<std::string> letters; // letter 0 is always BLANK
+    std::map<std::string, int> letter_ids;
+    std::vector<std::string> states;
+    int initial_state, accepting_state, rejecting_state;
+
+    // a transition is stored in entry_size = 1 + num_tapes consecutive ints:
+    // new state (-1 if there is no transition), then new_letter * 4 + (move + 1) for each tape
+    int entry_size;
+
+    // a transition is identified by state * row_size + sum(letter_on_tape_a * letters.size()^a);
+    // states below num_hot_states have all their row_size entries in hot_table, at that index
+    size_t row_size;
+    int num_hot_states;
+    std::vector<int> hot_table;
+
+    // transitions from the remaining states, packed one after another
+    std::unordered_map<size_t, size_t> cold_positions; // index -> position in cold_table
+    std::vector<size_t> cold_indices;
+    std::vector<int> cold_table;
+
+    // K is the number of tapes, known at compile time for K = 1 and K = 2; K = 0 means num_tapes
+    template<int K>
+    RunStats run_with_tapes(const std::vector<std::string> &input, long long max_steps,
+                            std::vector<long long> *hits) const;
+
+    template<int K>
+    RunStats run_on_disk_with_tapes(const std::vector<std::string> &input, long long max_steps,
+                                    const std::string &directory, long long checkpoint_interval, bool resume) const;
+
+    template<typename Tape>
+    void load_input(const std::vector<std::string> &input, Configuration<Tape> &conf) const;
+
+    // makes one step; returns false (with stats.result set) if the run has ended instead
+    template<int K, typename Tape>
+    bool step(Configuration<Tape> &conf, long long max_steps, RunStats &stats, std::vector<long long> *hits) const;
+
+    template<int K, typename Tape>
+    size_t table_index(const Configuration<Tape> &conf) const;
+
+    std::pair<std::string, std::vector<std::string>> transition_key(size_t index) const;
+
+    uint64_t cell_hash(int tape, long long pos, int letter) const;
+
+    template<int K>
+    uint64_t configuration_hash(const Configuration<std::vector<int>> &conf) const;
+
+    void write_checkpoint(const std::string &directory, Configuration<MappedTape> &conf, long long steps) const;
+
+    void read_checkpoint(const std::string &directory, Configuration<MappedTape> &conf, long long &steps) const;
+};
+
+#endif